@@ -0,0 +1,43 @@
+//
+// This file is part of the Tioga software library
+//
+// Tioga  is a tool for overset grid assembly on parallel distributed systems
+// Copyright (C) 2015 Jay Sitaraman
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#ifndef ALLOCCOUNT_H
+#define ALLOCCOUNT_H
+
+/**
+ * heap accounting of the benchmarks. With TIOGA_BENCH_ALLOC_COUNT
+ * (cmake option, off by default and with sanitizers) allocCount.C
+ * replaces the allocation functions of the process (glibc only) and
+ * counts the calls and the requested bytes, new and delete go 
+ * through them as well. Otherwise the counts stay zero
+ */
+struct allocStats
+{
+  long long nalloc;   /** < allocations (malloc, calloc, realloc of NULL) */
+  long long nfree;    /** < frees of non NULL pointers */
+  long long nbytes;   /** < bytes requested by malloc, calloc and realloc */
+};
+
+/** counts since the start of the process */
+void getAllocStats(allocStats *a);
+
+/** resident set size and its high water mark of the process in kB (Linux) */
+void getMemoryUsage(double *rss,double *hwm);
+
+#endif /* ALLOCCOUNT_H */
@@ -0,0 +1,164 @@
+//
+// This file is part of the Tioga software library
+//
+// Tioga  is a tool for overset grid assembly on parallel distributed systems
+// Copyright (C) 2015 Jay Sitaraman
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#ifndef BENCHMESH_H
+#define BENCHMESH_H
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdint.h>
+#include "mpi.h"
+
+/**
+ * synthetic hexahedral block for the benchmarks: n^3 cells 
+ * spanning len from xlo, rotated by angle about z, with
+ * node/cell global ids starting at gidOffset. The boundary
+ * nodes are tagged overset (obc) or wall (wbc) on request
+ */
+struct hexBlock
+{
+  int n;
+  int nnodes,ncells;
+  std::vector<double> x;
+  std::vector<int> iblank;
+  std::vector<int> conn;
+  std::vector<int> obc,wbc;
+  std::vector<uint64_t> nodegid,cellgid;
+  std::vector<double> q;
+  int nv,nc;
+  int *vconn[1];
+};
+
+inline void makeHexBlock(hexBlock &b,int n,const double xlo[3],double len,double angle,
+			 uint64_t gidOffset,int markObc,int markWbc)
+{
+  int i,j,k,m,n1;
+  double h,xp,yp;
+  //
+  b.n=n;
+  n1=n+1;
+  b.nnodes=n1*n1*n1;
+  b.ncells=n*n*n;
+  h=len/n;
+  b.x.resize(3*b.nnodes);
+  b.iblank.assign(b.nnodes,1);
+  b.nodegid.resize(b.nnodes);
+  b.obc.clear();
+  b.wbc.clear();
+  for(k=0;k<n1;k++)
+    for(j=0;j<n1;j++)
+      for(i=0;i<n1;i++)
+	{
+	  m=(k*n1+j)*n1+i;
+	  xp=i*h-0.5*len;
+	  yp=j*h-0.5*len;
+	  b.x[3*m]  =xlo[0]+0.5*len+xp*cos(angle)-yp*sin(angle);
+	  b.x[3*m+1]=xlo[1]+0.5*len+xp*sin(angle)+yp*cos(angle);
+	  b.x[3*m+2]=xlo[2]+k*h;
+	  b.nodegid[m]=gidOffset+m;
+	  if (i==0 || j==0 || k==0 || i==n || j==n || k==n)
+	    {
+	      if (markObc) b.obc.push_back(m+1);
+	      if (markWbc) b.wbc.push_back(m+1);
+	    }
+	}
+  b.conn.resize(8*b.ncells);
+  b.cellgid.resize(b.ncells);
+  m=0;
+  for(k=0;k<n;k++)
+    for(j=0;j<n;j++)
+      for(i=0;i<n;i++)
+	{
+	  int c=(k*n+j)*n+i;
+	  int p=(k*n1+j)*n1+i;
+	  b.conn[m++]=p+1;
+	  b.conn[m++]=p+2;
+	  b.conn[m++]=p+n1+2;
+	  b.conn[m++]=p+n1+1;
+	  b.conn[m++]=p+n1*n1+1;
+	  b.conn[m++]=p+n1*n1+2;
+	  b.conn[m++]=p+n1*n1+n1+2;
+	  b.conn[m++]=p+n1*n1+n1+1;
+	  b.cellgid[c]=gidOffset+c;
+	}
+  b.nv=8;
+  b.nc=b.ncells;
+  b.vconn[0]=b.conn.data();
+}
+
+/** a timed kernel: best and average wall time over the repetitions */
+struct benchResult
+{
+  std::string name;
+  double items;    /** < work items of one repetition (points, cells ..) */
+  int reps;
+  double tmin;
+  double tavg;
+};
+
+/** time f once for warm up then reps times */
+template<class F> benchResult timeKernel(const char *name,double items,int reps,F f)
+{
+  benchResult r;
+  double t0,dt;
+  r.name=name;
+  r.items=items;
+  r.reps=reps;
+  r.tmin=1e30;
+  r.tavg=0;
+  f();
+  for(int i=0;i<reps;i++)
+    {
+      t0=MPI_Wtime();
+      f();
+      dt=MPI_Wtime()-t0;
+      r.tmin=(dt < r.tmin) ? dt : r.tmin;
+      r.tavg+=dt;
+    }
+  r.tavg/=reps;
+  return r;
+}
+
+inline void writeResults(const char *fname,const char *suite,int size,
+			 std::vector<benchResult> &res)
+{
+  FILE *fp=fopen(fname,"w");
+  if (fp==NULL) return;
+  fprintf(fp,"{\n  \"suite\": \"%s\",\n  \"size\": %d,\n  \"results\": [\n",suite,size);
+  for(size_t i=0;i<res.size();i++)
+    fprintf(fp,"    {\"name\": \"%s\", \"items\": %.0f, \"reps\": %d, \"min\": %.6e, "
+	    "\"avg\": %.6e, \"items_per_s\": %.6e}%s\n",
+	    res[i].name.c_str(),res[i].items,res[i].reps,res[i].tmin,res[i].tavg,
+	    (res[i].tmin > 0) ? res[i].items/res[i].tmin : 0.0,(i+1 < res.size()) ? ",":"");
+  fprintf(fp,"  ]\n}\n");
+  fclose(fp);
+}
+
+inline void printResults(std::vector<benchResult> &res)
+{
+  printf("%-32s %12s %12s %12s %14s\n","kernel","items","min(s)","avg(s)","items/s");
+  for(size_t i=0;i<res.size();i++)
+    printf("%-32s %12.0f %12.4e %12.4e %14.4e\n",res[i].name.c_str(),res[i].items,
+	   res[i].tmin,res[i].tavg,(res[i].tmin > 0) ? res[i].items/res[i].tmin : 0.0);
+}
+
+#endif /* BENCHMESH_H */
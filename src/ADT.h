@@ -23,6 +23,7 @@
 
 #include <cstdlib>
 #include <memory>
+#include <vector>
 
 // forward declaration for instantiation
 class MeshBlock; 
@@ -40,9 +41,10 @@ class ADT
   double *adtReals;  /** < real numbers that provide the extents of each box */
   double *adtExtents; /** < global extents */
   double *coord;          /** < bounding box of each element */
+  int depth;         /** < number of levels of the built tree */
 
  public :
-  ADT() {ndim=6;nelem=0;adtIntegers=NULL;adtReals=NULL;adtExtents=NULL;coord=NULL;};
+  ADT() {ndim=6;nelem=0;depth=0;adtIntegers=NULL;adtReals=NULL;adtExtents=NULL;coord=NULL;};
   ~ADT() 
     {
       if (adtIntegers) free(adtIntegers);
@@ -60,9 +62,21 @@ class ADT
       adtIntegers=NULL;
       adtReals=NULL;
       adtExtents=NULL;
+      depth=0;
     };      
   void buildADT(int d,int nelements,double *elementBbox);  
-  void searchADT(MeshBlock *mb,int *cellindx,double *xsearch);
+  /** nvisit (if given) is incremented by the nodes visited [0] and
+      the containment tests done [1] */
+  void searchADT(MeshBlock *mb,int *cellindx,double *xsearch,double *rstout=NULL,
+		 int *nvisit=NULL);
+  /** all the elements whose boxes contain xsearch, in the order searchADT visits them */
+  void collectADT(double *xsearch,std::vector<int>& elements,int *nvisit=NULL);
+  /** number of levels, measured when the tree is built */
+  int getDepth(void) { return depth;};
+  int getNelem(void) { return nelem;};
+  /** bytes held by the tree */
+  size_t getMemory(void) 
+  { return (adtIntegers) ? ((size_t)nelem*(4*sizeof(int)+ndim*sizeof(double))+ndim*sizeof(double)) : 0;};
 };
 
 
@@ -24,11 +24,10 @@
 #include <cstdlib>
 #include "codetypes.h"
 
-struct INTERPLIST2;
-struct DONORLIST;
 struct HOLEMAP;
 
 class CartGrid;
+class diagOutput;
 class CartBlock
 {
  private:
@@ -36,38 +35,89 @@ class CartBlock
   int global_id;
   int dims[3],nf,qstride,ndof,pdegree,p3;
   int d1,d2,d3,d3nf;
+  int qlayout;          /** < variable layout of q, ROW (0) or COLUMN (1) */
+  int qvstride;         /** < distance between variables of a point in q */
   int myid;
   int *ibl;
   double *q;
   double *qnode;
   double xlo[3]; 
   double dx[3];
-  int ndonors;
-  int interpListSize;
-  INTERPLIST2 *interpList,*listptr;
-  DONORLIST **donorList;
+  //
+  // receptors interpolated from this patch, weights
+  // and flat q indices of the stencil are stored CSR wise
+  //
+  int ninterp;          /** < number of receptors */
+  int maxinterp;        /** < allocated receptor capacity */
+  int maxweights;       /** < allocated weight capacity */
+  int *interpInfo;      /** < (procid,remoteid,remoteblockid) of each receptor */
+  int *interpPtr;       /** < start of each receptor in interpWeights */
+  int *interpIndex;     /** < q index (first variable) of every weight */
+  double *interpWeights;/** < interpolation weights */
+  //
+  // donor candidates for the patch dofs, appended
+  // flat and sorted into CSR by dof in processDonors
+  //
+  int ndonors;          /** < number of donor candidates */
+  int maxdonors;        /** < allocated donor capacity */
+  int *donorData;       /** < (senderid,meshtag,remoteid,remoteblockid) */
+  int *donorDof;        /** < receiving dof of each donor */
+  int *donorCancel;     /** < cancel flag of each donor */
+  double *donorRes;     /** < donor cell resolution */
+  int *donorPtr;        /** < start of each dof in donorIdx */
+  int *donorIdx;        /** < donors sorted by dof, then resolution */
+  int ndofAlloc;        /** < size of donorPtr - 1 */
+  //
+  // iblank entries changed by the last connectivity, kept so that 
+  // the next connectivity starts from the solver's values
+  //
+  int nibmod;           /** < number of changed entries */
+  int maxibmod;         /** < allocated capacity */
+  int *ibmod;           /** < (ibindex,old value,new value) triplets */
+  void setIblank(int ibindex,int value);
   void (*donor_frac) (int *,double *,int *,double *);
+  void sortDonors(void);
+  void getQIndex(int i,int j,int k,int *index);
+  int layoutIndex(int index);
  public:
-  CartBlock() { global_id=0;dims[0]=dims[1]=dims[2]=0;ibl=NULL;q=NULL;interpListSize=0;donorList=NULL;interpList=NULL;
+  CartBlock() { global_id=0;dims[0]=dims[1]=dims[2]=0;ibl=NULL;q=NULL;qlayout=1;qvstride=0;
+    ninterp=maxinterp=maxweights=0;interpInfo=interpPtr=interpIndex=NULL;interpWeights=NULL;
+    ndonors=maxdonors=ndofAlloc=0;donorData=donorDof=donorCancel=donorPtr=donorIdx=NULL;donorRes=NULL;
+    nibmod=maxibmod=0;ibmod=NULL;
     donor_frac=nullptr;};
-  ~CartBlock() { clearLists();};
-  void registerData(int local_id_in,int global_id_in,int *iblankin,double *qin)
+  ~CartBlock();
+  //
+  // qlayoutin=1 (COLUMN) is the native Q[p+1,p+1,p+1,nq,nZ,nY,nX] storage,
+  // qlayoutin=0 (ROW) keeps the nq variables of every point contiguous
+  //
+  void registerData(int local_id_in,int global_id_in,int *iblankin,double *qin,
+                    int qlayoutin=1)
   {
+    if (iblankin!=ibl || global_id_in!=global_id) nibmod=0;
     local_id=local_id_in;
     global_id=global_id_in;
     ibl=iblankin;
     q=qin;
+    qlayout=qlayoutin;
   };
+  /** true if the patch is already registered with this id and iblank */
+  bool isRegistered(int global_id_in,int *iblankin)
+  { return (ibl!=NULL && ibl==iblankin && global_id==global_id_in);};
+  void resetIblanks(void);
+  void applyIblanks(void);
   void preprocess(CartGrid *cg);
-  void getInterpolatedData(int *nints,int *nreals,int **intData,
-			   double **realData,
+  int getInterpCount(void) { return ninterp;};
+  int getCellCount(void) { return dims[0]*dims[1]*dims[2];};
+  void getInterpolatedData(int *nints,int *nreals,int *intData,
+			   double *realData,
 			   int nvar);
   void update(double *qval,int index,int nq);
+  void update(int nupdate,int *index,double *qval,int nq);
   void getCancellationData(int *cancelledData, int *ncancel);
   void processDonors(HOLEMAP *holemap, int nmesh);
   void insertInDonorList(int senderid,int index,int meshtagdonor,int remoteid,int remoteblockid,double cellRes);
   void insertInInterpList(int procid,int remoteid,int remoteblockid,double *xtmp);
-  void writeCellFile(int bid);
+  void writeCellFile(int bid,diagOutput *dg=NULL);
   void clearLists(void);
   void initializeLists(void);
 };
@@ -22,6 +22,9 @@
 #define CARTGRID_H
 
 #include <cstdlib>
+#include <map>
+
+class diagOutput;
 
 class CartGrid
 {
@@ -30,6 +33,15 @@ class CartGrid
   double *dxlvl;
   int *lcount;
   int maxlevel;
+  double *lxlo;     /** < lower corner of each level's bin grid */
+  int *lbinsize;    /** < bin width (in level cells) per level and direction */
+  int *lnbins;      /** < number of bins per level and direction */
+  int *lbinstart;   /** < offset of each level's first bin in binptr */
+  int *binptr;      /** < CSR start index of each bin in binlist */
+  int *binlist;     /** < patch ids overlapping each bin, ascending order */
+  void clearSearchData(void);
+  int getBinIndex(int l,double *x);
+  std::map<int,int> idIndex; /** < index of each global id in the patch arrays */
 
  public :
   int *global_id;
@@ -40,17 +52,20 @@ class CartGrid
   int *ilo;
   int *ihi;
   int *dims;
+  int *pstamp;      /** < registration stamp of each patch, unique per process */
   int myid;
-  int nf,qstride;
+  int nf,qstride,nqnode;
   double *xlo;
   double *dx;
   double *qnode;
   int ngrids;
   void (*donor_frac) (int *,double *,int *,double *);
    
-  CartGrid() { ngrids=0;global_id=NULL;level_num=NULL;local_id=NULL;porder=NULL;
-    proc_id=NULL;local_id=NULL;ilo=NULL;ihi=NULL;dims=NULL;
-               xlo=NULL;dx=NULL;dxlvl=NULL;lcount=NULL;qnode=NULL;donor_frac=nullptr;};
+  CartGrid() { ngrids=0;nqnode=0;global_id=NULL;level_num=NULL;local_id=NULL;porder=NULL;
+    proc_id=NULL;local_id=NULL;ilo=NULL;ihi=NULL;dims=NULL;pstamp=NULL;
+               xlo=NULL;dx=NULL;dxlvl=NULL;lcount=NULL;qnode=NULL;donor_frac=nullptr;
+               lxlo=NULL;lbinsize=NULL;lnbins=NULL;lbinstart=NULL;binptr=NULL;
+               binlist=NULL;maxlevel=0;};
   ~CartGrid() { 
     if (global_id) free(global_id);
     if (level_num) free(level_num);
@@ -60,15 +75,27 @@ class CartGrid
     if (ilo) free(ilo);
     if (ihi) free(ihi);
     if (dims) free(dims);
+    if (pstamp) free(pstamp);
     if (xlo) free(xlo);
     if (dx) free(dx);
-    if (lcount) free(lcount);
-    if (dxlvl) free(dxlvl);
     if (qnode) free(qnode);
+    clearSearchData();
   };
   void registerData(int nf,int qstride,double *qnodein,
 		    int *idata,double *rdata,
 		    int ngridsin,int qnodesize);
+  void updateData(int nremove,int *removeid,int nadd,
+		  int *idata,double *rdata);
+  void writeData(diagOutput *dg);
+  /** index of the patch with global id id in the patch arrays, -1 if none */
+  int patchIndex(int id) 
+  { 
+    std::map<int,int>::iterator it=idIndex.find(id);
+    return (it==idIndex.end()) ? -1 : it->second;
+  };
+  bool sameData(int nf,int qstride,double *qnodein,
+		int *idata,double *rdata,
+		int ngridsin,int qnodesize);
   void preprocess(void);     
   void search(double *x,int *donorid,int nsearch);
   void setcallback(void (*f1)(int *,double *,int *,double *)) 
@@ -26,9 +26,11 @@
 #include <assert.h>
 #include "codetypes.h"
 #include "ADT.h"
+#include "scratchArena.h"
 // forward declare to instantiate one of the methods
 class parallelComm;
 class CartGrid;
+class diagOutput;
 
 /**
  * MeshBlock class - container and functions for generic unstructured grid partition in 3D
@@ -57,6 +59,9 @@ class MeshBlock
   uint64_t *nodeGID;     /**< Global ID for the nodes */
   //
   double *nodeRes;  /** < node resolution  */
+  int rigidMotion;        /** < the block only moves rigidly, keep the resolutions */
+  double *nodeResRigid;   /** < nodeRes of the first tagBoundary under rigid motion */
+  int rigidSize[2];       /** < nnodes and ncells nodeResRigid was computed for */
   double *userSpecifiedNodeRes;
   double *userSpecifiedCellRes;
   double *elementBbox; /** < bounding box of the elements */
@@ -74,20 +79,39 @@ class MeshBlock
                                  who they donate to */ 
   int *interp2donor;
 
-  INTEGERLIST *cancelList;  /** receptors that need to be cancelled because of */
-  int ncancel;              /** conflicts with the state of their donors */
+  std::vector<int> cancelList; /** receptors that need to be cancelled because of conflicts
+                                   with the state of their donors or by fringe reduction */
+  //
+  // node to cell adjacency (CSR over the nodes, cells numbered
+  // across the types) for fringe reduction, kept until the
+  // next setData
+  //
+  std::vector<int> nodeCellPtr;
+  std::vector<int> nodeCell;
+  int **adjConn;
+  int adjSize[2];
   void (*get_nodes_per_cell)(int*, int*);
   void (*get_receptor_nodes)(int *,int *,double *);
   void (*donor_inclusion_test)(int *,double *,int *,double *);
   void (*donor_frac)(int *,double *,int *,int *,double *,double *,int *);
   void (*convert_to_modal)(int *,int *,double *,int *,int *,double *);
+  //
+  // batched versions of the high-order callbacks, each call
+  // handles a list of cells or points, see setbatchcallback.
+  // A NULL entry falls back to the per item callback
+  //
+  void (*get_nodes_per_cell_batch)(int *,int *,int *);
+  void (*get_receptor_nodes_batch)(int *,int *,int *,double *);
+  void (*donor_inclusion_test_batch)(int *,int *,double *,int *,double *);
+  void (*donor_frac_batch)(int *,int *,double *,int *,int *,double *,double *,int *);
+  void (*convert_to_modal_batch)(int *,int *,int *,double *,int *,int *,int *,double *);
+  int hoThreadSafe;        /** < per item callbacks may be called from several threads */
 
   int nreceptorCells;      /** number of receptor cells */
   int *ctag;               /** index of receptor cells */
   int *pointsPerCell;      /** number of receptor points per cell */
   int maxPointsPerCell;     /** max of pointsPerCell vector */
   double *rxyz;            /**  point coordinates */
-  int ipoint; 
   int *picked;             /** < flag specifying if a node has been selected for high-order interpolation */
 
   int nreceptorCellsCart;
@@ -103,6 +127,7 @@ class MeshBlock
   int *icft; 	   // frequency table for nodal containment
   int mapdims[3];  // dimensions of the map
   double mapdx[3]; // sides of the map
+  scratchArena *scratch; /** < scratch memory of the owning tioga instance */
  public :
   int *iblank;      /** < iblank value for each grid node */
   int *iblank_reduced;
@@ -130,19 +155,75 @@ class MeshBlock
   double *xsearch;    /** < coordinates of the query points */
   double *rst;            /**  natrural coordinates */
   int *donorId;       /** < donor indices for those found */
+  int searchCapacity;  /** < query points the search arrays above are allocated for */
+  int xtagCapacity;    /** < entries allocated in xtag */
+  //
+  // chunked search (see tioga::setMemoryBudget): the query points of
+  // the earlier rounds that found a donor stay at the front of the
+  // search arrays, the points of the current round follow them
+  //
+  int nfound;          /** < points of the earlier rounds kept */
+  int roundStart;      /** < first point of the round being searched */
+  int chunkedSearch;   /** < 1 in a chunked search, 2 once its ADT is built */
+  double uniqueBytes;  /** < bytes of the duplicate point map of the last search */
+  int donorListCount;  /** < entries in the donor lists */
   std::vector<uint64_t> gid_search; /**< Global node ID for the query points */
   int donorCount;
+  double searchCount[2];  /** < ADT nodes visited and containment tests of the last search */
+  //
+  // connectivity cost of the cells of this block (for repartitioning),
+  // only tracked if trackCost is set
+  //
+  int trackCost;
+  std::vector<int> cellTests;   /** < containment tests done in each cell */
+  std::vector<int> cellDonors;  /** < query points each cell is the donor of */
   int myid;
   double *cellRes;  /** < resolution for each cell */
   int ntotalPoints;        /**  total number of extra points to interpolate */
   int ihigh;
   int ninterp2;            /** < number of interpolants for high-order points */
-  int interp2ListSize;
-  INTERPLIST *interpList2; /** < list for high-interpolation points */
+  //
+  // interpolation of the high-order points, CSR wise
+  //
+  int maxinterp2;          /** < allocated receptor capacity */
+  int maxweights2;         /** < allocated weight capacity */
+  int *interp2Info;        /** < (procid,remoteid,remoteblockid) of each receptor */
+  int *interp2Ptr;         /** < start of each receptor in interp2Weights */
+  int *interp2Node;        /** < donor node of every weight (high order: first dof in q) */
+  double *interp2Weights;  /** < interpolation weights */
+  void reserveInterp2Weights(int n);
+  //
+  // scratch of the batched high-order callbacks, kept between calls
+  //
+  std::vector<int> hoIntWork;
+  std::vector<double> hoRealWork;
+  //
+  // plan of the point update (dataUpdate at_points=1), 
+  // built once per performConnectivityHighOrder
+  //
+  std::vector<double> pointQ;  /** < received values of the points */
+  std::vector<int> pointRecv;  /** < 1 if the point has a donor, 0 if orphan */
+  std::vector<int> modalCell;  /** < receptor cells whose points are updated */
+  std::vector<int> modalPts;   /** < number of points of each of these cells */
+  std::vector<int> modalStart; /** < index of their first point in pointQ */
+  int modalPtsMax;             /** < max of modalPts */
+  std::vector<int> orphanCells;/** < (cell,iblank_cell) pairs set by clearOrphans */
   int ninterpCart;
   int interpListCartSize;
   INTERPLIST *interpListCart; 
   int* receptorIdCart;
+  //
+  // Cartesian receptor points found by getCartReceptors, cached per
+  // patch so that the receptors of unchanged patches are not looked
+  // for again. The donor search and exchange still cover all patches
+  //
+  int ncartCache;          /** < number of patches in the cache */
+  int *cartCacheId;        /** < global id of each cached patch */
+  int *cartCacheStamp;     /** < CartGrid stamp of each cached patch */
+  int *cartCachePtr;       /** < start of each patch in the cached points */
+  int *cartCacheIndex;     /** < q index of each cached point */
+  double *cartCacheXyz;    /** < coordinates of each cached point */
+  uint64_t cartCacheHash;  /** < coordinate signature the cache was built with */
 
   //
   // call back functions to use p4est to search
@@ -157,15 +238,27 @@ class MeshBlock
   MeshBlock() { nv=NULL; nc=NULL; x=NULL;iblank=NULL;iblank_cell=NULL;vconn=NULL;wbcnode=NULL;
     obcnode=NULL; cellRes=NULL; nodeRes=NULL; elementBbox=NULL; elementList=NULL; adt=NULL; donorList=NULL;
     interpList=NULL; interp2donor=NULL; obb=NULL; nsearch=0; isearch=NULL; tagsearch=NULL;
-    res_search=NULL;xsearch=NULL; donorId=NULL;xtag=NULL;
-    adt=NULL; cancelList=NULL; userSpecifiedNodeRes=NULL; userSpecifiedCellRes=NULL; nfringe=1;
+    res_search=NULL;xsearch=NULL; donorId=NULL;xtag=NULL;searchCapacity=xtagCapacity=0;
+    uniqueBytes=0;donorListCount=0;chunkedSearch=0;nfound=roundStart=0;
+    scratch=NULL;
+    adt=NULL; userSpecifiedNodeRes=NULL; userSpecifiedCellRes=NULL; nfringe=1;
     mexclude=3;
     // new vars
-    ninterp=ninterp2=interpListSize=interp2ListSize=0;
-    ctag=NULL;pointsPerCell=NULL;maxPointsPerCell=0;rxyz=NULL;ntotalPoints=0;rst=NULL;ihigh=0;ipoint=0;
-    interpList2=NULL;picked=NULL;ctag_cart=NULL;rxyzCart=NULL;donorIdCart=NULL;pickedCart=NULL;ntotalPointsCart=0;
+    ninterp=ninterp2=interpListSize=0;
+    ctag=NULL;pointsPerCell=NULL;maxPointsPerCell=0;rxyz=NULL;ntotalPoints=0;rst=NULL;ihigh=0;hoThreadSafe=0;modalPtsMax=0;
+    searchCount[0]=searchCount[1]=0;trackCost=0;
+    rigidMotion=0;nodeResRigid=NULL;rigidSize[0]=rigidSize[1]=-1;
+    adjConn=NULL;adjSize[0]=adjSize[1]=-1;
+    maxinterp2=maxweights2=0;interp2Info=NULL;interp2Ptr=NULL;interp2Node=NULL;interp2Weights=NULL;
+    picked=NULL;ctag_cart=NULL;rxyzCart=NULL;donorIdCart=NULL;pickedCart=NULL;ntotalPointsCart=0;
     nreceptorCellsCart=0;ninterpCart=0;interpListCartSize=0;interpListCart=NULL;
     resolutionScale=1.0; receptorIdCart=NULL;
+    get_nodes_per_cell=NULL;get_receptor_nodes=NULL;donor_inclusion_test=NULL;
+    donor_frac=NULL;convert_to_modal=NULL;
+    get_nodes_per_cell_batch=NULL;get_receptor_nodes_batch=NULL;donor_inclusion_test_batch=NULL;
+    donor_frac_batch=NULL;convert_to_modal_batch=NULL;
+    ncartCache=0;cartCacheId=NULL;cartCacheStamp=NULL;cartCachePtr=NULL;cartCacheIndex=NULL;cartCacheXyz=NULL;
+    cartCacheHash=0;
 
     cellGID = NULL;
     iblank_reduced=NULL;
@@ -185,7 +278,7 @@ class MeshBlock
 
   void tagBoundary(void);
   
-  void writeGridFile(int bid);
+  void writeGridFile(int bid,diagOutput *dg=NULL);
 
   void writeFlowFile(int bid,double *q,int nvar,int type);
   
@@ -199,7 +292,22 @@ class MeshBlock
 	       
   void search();
   void search_uniform_hex();
-  void writeOBB(int bid);
+  void searchBatched(void);
+  /** size the query point arrays for nsearch points, they are only
+      reallocated when they grow (keeping the found points of a 
+      chunked search) */
+  void allocSearchArrays(void);
+  void freeSearchArrays(void);
+  void buildSearchADT(void);
+  /** chunked search: each round searches the points after the nfound
+      kept ones and keeps those that found a donor, the last call makes
+      the kept points the query points */
+  void startChunkedSearch(void);
+  void searchRound(void);
+  void finishChunkedSearch(void);
+  /** bytes held by this block, added to mem[TIOGA_M_*] (perfStats.h) */
+  void getMemoryUsage(double *mem);
+  void writeOBB(int bid,diagOutput *dg=NULL);
 
   void writeOBB2(OBB *obc,int bid);
 
@@ -207,13 +315,15 @@ class MeshBlock
 
   int getNinterp(void) {return ninterp;};
 
+  int getADTDepth(void) { return (adt) ? adt->getDepth() : 0;};
+
   void getInterpolatedSolution(int *nints,int *nreals,int **intData,double **realData,double *q,
 			       int nvar, int interptype);
 
   void getInterpolatedSolutionAMR(int *nints,int *nreals,int **intData,double **realData,double *q,
 				  int nvar, int interptype);
   
-  void checkContainment(int *cellIndex,int adtElement,double *xsearch);
+  void checkContainment(int *cellIndex,int adtElement,double *xsearch,double *rstout=NULL);
 
   void getWallBounds(int *mtag,int *existWall, double wbox[6]);
   
@@ -254,6 +364,11 @@ class MeshBlock
   
   void getStats(int mstat[2]);
 
+  /** zero the cell costs, allocated if tracked */
+  void resetConnectivityWeights(void);
+
+  void getConnectivityWeights(int *ctests,int *cdonors,int *ncandidates,int *nreceptor);
+
   void setIblanks(int inode);
 
   void getDonorCount(int *dcount,int *fcount);
@@ -287,6 +402,56 @@ class MeshBlock
     donor_frac=f4;
     convert_to_modal=f5;
   }
+  /** batched high-order callbacks (all arguments are pointers, Fortran style):
+      f1(ncell,cellid,npts)                  : number of points of each cell 
+      f2(ncell,cellid,npts,xyz)              : points of all cells, concatenated
+      f3(npts,cellid,xyz,passflag,rst)       : inclusion test of each (cell,point) pair
+      f4(npts,cellid,xyz,nweights,inode,frac,rst,ndim)
+                                             : weights of each point, frac of point i
+                                               starts at i*ndim
+      f5(ncell,cellid,nptsin,qin,ndim,nptsout,index_out,qout)
+                                             : modal conversion of each cell, qin is
+                                               concatenated, qout of cell i starts at
+                                               i*ndim (values, not points) */
+  void setbatchcallback(void (*f1)(int *,int *,int *),
+			void (*f2)(int *,int *,int *,double *),
+			void (*f3)(int *,int *,double *,int *,double *),
+			void (*f4)(int *,int *,double *,int *,int *,double *,double *,int *),
+			void (*f5)(int *,int *,int *,double *,int *,int *,int *,double *))
+  {
+    get_nodes_per_cell_batch=f1;
+    get_receptor_nodes_batch=f2;
+    donor_inclusion_test_batch=f3;
+    donor_frac_batch=f4;
+    convert_to_modal_batch=f5;
+  }
+  //
+  // callback dispatch, batched if available, per item otherwise
+  //
+  void getNodesPerCell(int ncell,int *cellid,int *npts);
+  void getReceptorNodes(int ncell,int *cellid,int *npts,double *xyz);
+  void donorInclusionTest(int npts,int *cellid,double *xyz,int *passFlag,double *rstout);
+  void donorFrac(int npts,int *cellid,double *xyz,int *nweights,int *inode,
+		 double *frac,double *rstin,int ndim);
+  void convertToModal(int ncell,int *cellid,int *nptsin,double *qin,int nvar,int ndim,
+		      int *nptsout,int *index_out,double *qout);
+
+  void setHighOrderThreadSafe(int flag) { hoThreadSafe=flag;}
+
+  /** the coordinates of this block only change by rigid motion, the cell 
+      volumes and resolutions are then computed by the first preprocess only */
+  void setRigidMotion(int flag) { rigidMotion=flag;}
+
+  //
+  // temporaries come from the scratch arena of the owning tioga
+  // instance, they are malloc'ed if the block is used without one
+  //
+  void setScratch(scratchArena *s) { scratch=s;}
+  template <class T> T *getScratch(size_t n)
+  { return (scratch) ? scratch->get<T>(n) : (T *)malloc(sizeof(T)*n);}
+  void putScratch(void *p) { if (scratch==NULL) free(p);}
+  size_t scratchMark(void) { return (scratch) ? scratch->mark() : 0;}
+  void scratchRewind(size_t m) { if (scratch) scratch->rewind(m);}
 
   void setp4estcallback(void (*f1)(double *,int *,int *,int *),
 			void (*f2)(int *,int *))
@@ -295,7 +460,8 @@ class MeshBlock
     check_intersect_p4est=f2;
   }
 
-  void writeCellFile(int);
+  void writeCellFile(int,diagOutput *dg=NULL);
+  void writeBinaryGrid(int bid,diagOutput *dg,int withCells);
   void getInternalNodes(void);
   void getExtraQueryPoints(OBB *obb,int *nints,int **intData,int *nreals,
 		      double **realData);
@@ -305,11 +471,17 @@ class MeshBlock
 				       double *q,
 				       int nvar, int interptype);
   void updatePointData(double *q,double *qtmp,int nvar,int interptype);
+  /** flags of the points that receive data, all cleared */
+  int *getPointRecvFlags(void) { pointRecv.assign(ntotalPoints,0); return pointRecv.data();}
+  /** receive buffer of the point values for nvar variables */
+  double *getPointBuffer(int nvar) { pointQ.resize((size_t)ntotalPoints*nvar); return pointQ.data();}
+  int setupPointUpdate(HOLEMAP *holemap,int nmesh);
   void outputOrphan(FILE *fp,int i) 
   {
     fprintf(fp,"%f %f %f\n",rxyz[3*i],rxyz[3*i+1],rxyz[3*i+2]);
   }
   void clearOrphans(HOLEMAP *holemap,int nmesh,int *itmp);
+  void reapplyOrphans(void);
   void getUnresolvedMandatoryReceptors();
   void getCartReceptors(CartGrid *cg, parallelComm *pc);
   void setCartIblanks(void);
@@ -346,11 +518,25 @@ class MeshBlock
     ninterp = 0;
     interpListSize = 0;
   }
+  void buildNodeCellAdjacency(void);
+
   void reduce_fringes() ;
 
   void check_for_uniform_hex();
 
   void create_hex_cell_map();
+
+  uint64_t getCoordHash(void);
+
+  uint64_t getMeshHash(void);
+
+  /** iblank, iblank_cell and the interpolation list of the last
+      connectivity as binary records (see tioga::writeConnectivity) */
+  void writeConnectivity(diagOutput *dg);
+
+  /** read the records of writeConnectivity from buf at *pos, only 
+      checked against this block unless apply is set, 0 on mismatch */
+  int readConnectivity(const std::vector<char>& buf,size_t *pos,int apply);
 };
 
 #endif /* MESHBLOCK_H */
@@ -53,6 +53,7 @@
 #define BIGINT             2147483647
 #define TOL                1.0e-10
 #define HOLEMAPSIZE        192
+#define CART_THREAD_CELLS  4096   /* patches this large split their cells among threads */
 // #define NFRINGE            3
 // #define NVAR               6
 /*==================================================================*/
@@ -0,0 +1,71 @@
+//
+// This file is part of the Tioga software library
+//
+// Tioga  is a tool for overset grid assembly on parallel distributed systems
+// Copyright (C) 2015 Jay Sitaraman
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#ifndef DIAGOUTPUT_H
+#define DIAGOUTPUT_H
+#include "codetypes.h"
+#include <vector>
+#include "mpi.h"
+
+/*====================================================================*/
+/*  Diagnostic output modes                                           */
+/*====================================================================*/
+# define TIOGA_DIAG_NONE       0   /* no debug files (default)              */
+# define TIOGA_DIAG_TEXT       1   /* tecplot text, one file per block       */
+# define TIOGA_DIAG_BINARY     2   /* raw binary records, one file per rank  */
+# define TIOGA_DIAG_COLLECTIVE 3   /* raw binary records, one shared file    */
+
+/**
+* Diagnostic (debug) output
+* the debug writers append binary records
+* to the buffer of this class, which then writes
+* them per rank or collectively through MPI-IO.
+* In text mode the writers produce their tecplot
+* files themselves and the buffer stays empty */
+class diagOutput
+{
+ private:
+  std::vector<char> buf;
+
+ public :
+  int mode;
+  int myid;
+  int numprocs;
+  MPI_Comm scomm;
+
+  diagOutput() { mode=TIOGA_DIAG_NONE;myid=0;numprocs=1;scomm=MPI_COMM_NULL;}
+
+  /** true if the writers should fill the buffer instead of text files */
+  bool isBinary(void) { return (mode==TIOGA_DIAG_BINARY || mode==TIOGA_DIAG_COLLECTIVE);}
+
+  void put(const void *data,size_t nbytes);
+
+  void put(int i) { put((const void *)&i,sizeof(int));}
+
+  void put(const int *data,size_t n) { put((const void *)data,sizeof(int)*n);}
+
+  void put(const double *data,size_t n) { put((const void *)data,sizeof(double)*n);}
+
+  /** write the buffered records to <name>NNNNN.bin (per rank)
+      or <name>.bin (collective) and empty the buffer, nonzero
+      if the file could not be written */
+  int flush(const char *name);
+};
+
+#endif /* DIAGOUTPUT_H */
@@ -17,22 +17,120 @@
 // You should have received a copy of the GNU Lesser General Public
 // License along with this library; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
-#include <vector>
+#include <algorithm>
+#include <stdexcept>
 
 #ifndef LINCARTINTERP_H
 #define LINCARTINTERP_H
 
 namespace cart_interp
 {
-void compute_1d_bases(const int& p, const std::vector<double>& ref_coord,
-  std::vector<double>& phi_x, std::vector<double>& phi_y, std::vector<double>& phi_z);
+//
+// number of stencil points of a (p+1)^3 donor stencil
+//
+template<int P>
+struct stencil_size { static constexpr int value=(P+1)*(P+1)*(P+1); };
 
-void compute_linear_weights(const std::vector<double>& ref_coord, double* weights);
+//
+// 1-D shape functions in a (-1,1) reference element, only
+// the linear (P=1) stencil is implemented
+//
+template<int P>
+inline void compute_1d_bases(const double* ref_coord,
+  double* phi_x, double* phi_y, double* phi_z);
 
-void compute_ref_coords(double* ref_ratio, std::vector<double>& ref_coord);
+template<>
+inline void compute_1d_bases<1>(const double* ref_coord,
+  double* phi_x, double* phi_y, double* phi_z)
+{
+  phi_x[0]=(1-ref_coord[0])/2;
+  phi_x[1]=(1+ref_coord[0])/2;
+
+  phi_y[0]=(1-ref_coord[1])/2;
+  phi_y[1]=(1+ref_coord[1])/2;
 
-void create_donor_stencil(const int& p, int* ijk_cell, int* dims, double* ref_ratio, int* ijk_stencil);
+  phi_z[0]=(1-ref_coord[2])/2;
+  phi_z[1]=(1+ref_coord[2])/2;
+}
 
+template<int P>
+inline void compute_weights(const double* ref_coord, double* weights)
+{
+  double phi_x[P+1],phi_y[P+1],phi_z[P+1];
+
+  compute_1d_bases<P>(ref_coord,phi_x,phi_y,phi_z);
+
+  int ind = 0;
+  for(int k=0;k<P+1;k++)
+    for(int j=0;j<P+1;j++) {
+      double phi_yz=phi_z[k]*phi_y[j];
+      for(int i=0;i<P+1;i++)
+        weights[ind++] = phi_yz*phi_x[i];
+    }
+}
+
+template<int P>
+inline void compute_ref_coords(const double* ref_ratio, double* ref_coord)
+{
+  // reference coordinates in -1 to 1. Assumes cells of uniform sizes
+  for(int n=0;n<3;n++)
+    ref_coord[n] = (ref_ratio[n]-0.5>=0) ?
+      ((ref_ratio[n]-0.5)/P*2-1) : ((ref_ratio[n]+0.5*(2*P-1))/P*2-1);
+}
+
+template<int P>
+inline void create_donor_stencil(const int* ijk_cell, const int* dims,
+  const double* ref_ratio, int* ijk_stencil)
+{
+  // determine start node if donor stencil is
+  // right/left or front/behind or above/below of ijk_cell cell-center
+  int start[3];
+  for(int n=0;n<3;n++)
+    start[n] = (ref_ratio[n]-0.5>=0) ? (ijk_cell[n]) : (ijk_cell[n]-1);
+
+  int ind = 0;
+  for(int k=0;k<P+1;k++)
+    for(int j=0;j<P+1;j++)
+      for(int i=0;i<P+1;i++) {
+        ijk_stencil[ind++] = std::max(0, std::min(start[0]+i, dims[0]-1));
+        ijk_stencil[ind++] = std::max(0, std::min(start[1]+j, dims[1]-1));
+        ijk_stencil[ind++] = std::max(0, std::min(start[2]+k, dims[2]-1));
+      }
+}
+
+//
+// (P+1)^3-node donor stencil where the nodes are neighboring cell-centers
+// ordering of cell centers in donor stencil is such that
+// left->right is along x-axis. back->front is along y-axis. bottom->top is along z-axis
+//
+template<int P>
+inline void linear_interpolation(const int* ijk_cell, const int* dims,
+  const double* ref_ratio, int* ijk_stencil, double* weights)
+{
+  double ref_coord[3];
+  create_donor_stencil<P>(ijk_cell,dims,ref_ratio,ijk_stencil);
+  compute_ref_coords<P>(ref_ratio,ref_coord);
+  compute_weights<P>(ref_coord,weights);
+}
+
+//
+// batched version for npts receptors, ijk_cell and ref_ratio hold
+// 3 entries per receptor, ijk_stencil 3*stencil_size<P> and weights
+// stencil_size<P> entries per receptor
+//
+template<int P>
+inline void linear_interpolation(int npts, const int* ijk_cell, const int* dims,
+  const double* ref_ratio, int* ijk_stencil, double* weights)
+{
+  constexpr int nw=stencil_size<P>::value;
+  for(int i=0;i<npts;i++)
+    linear_interpolation<P>(&ijk_cell[3*i],dims,&ref_ratio[3*i],
+                            &ijk_stencil[3*nw*i],&weights[nw*i]);
+}
+
+//
+// runtime order dispatch, kept for existing callers
+//
 void linear_interpolation(const int& p, int* ijk_cell, int* dims, double* ref_ratio,
   int* nw, int* ijk_stencil, double* weights);
 } // namespacee cart_interp
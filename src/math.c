@@ -86,14 +86,15 @@ void newtonSolve(double f[7][3],double *u1,double *v1,double *w1)
   int iter,itmax,isolflag;
   double u,v,w;
   double uv,wu,vw,uvw,norm,convergenceLimit;
-  double *rhs;
-  double **lhs;
+  double rhs[3];
+  double a[3][3];
+  double *lhs[3];
   double alph;
   //
-  lhs=(double **)malloc(sizeof(double)*3);
-  for(i=0;i<3;i++)
-    lhs[i]=(double *)malloc(sizeof(double)*3);
-  rhs=(double *)malloc(sizeof(double)*3);
+  // the 3x3 system lives on the stack, this is called
+  // for every containment test of a hexahedron
+  //
+  for(i=0;i<3;i++) lhs[i]=a[i];
   //
   itmax=500;
   convergenceLimit=1e-14;
@@ -139,9 +140,6 @@ void newtonSolve(double f[7][3],double *u1,double *v1,double *w1)
   *u1=u;
   *v1=v;
   *w1=w;
-  for(i=0;i<3;i++) TIOGA_FREE(lhs[i]);
-  TIOGA_FREE(lhs);
-  TIOGA_FREE(rhs);
   return;
 }
 
@@ -149,8 +147,9 @@ void newtonSolve(double f[7][3],double *u1,double *v1,double *w1)
 void computeNodalWeights(double xv[8][3],double *xp,double frac[8],int nvert)
 {
   int i,j,k,isolflag;
-  double **lhs;
-  double *rhs;
+  double a[3][3];
+  double *lhs[3];
+  double rhs[3];
   double f[8][3];
   double u,v,w;
   double oneminusU,oneminusV,oneminusW,oneminusUV;
@@ -161,10 +160,7 @@ void computeNodalWeights(double xv[8][3],double *xp,double frac[8],int nvert)
       //
       // tetrahedron
       //
-      lhs=(double **)malloc(sizeof(double)*3);
-      for(i=0;i<3;i++)
-	lhs[i]=(double *)malloc(sizeof(double)*3);
-      rhs=(double *)malloc(sizeof(double)*3);       
+      for(i=0;i<3;i++) lhs[i]=a[i];
       for(k=0;k<3;k++)
 	{
 	  for(j=0;j<3;j++)
@@ -188,9 +184,6 @@ void computeNodalWeights(double xv[8][3],double *xp,double frac[8],int nvert)
 	  frac[0]=1.0;
 	  frac[1]=frac[2]=frac[3]=0;
 	}
-      for(i=0;i<3;i++) TIOGA_FREE(lhs[i]);
-      TIOGA_FREE(lhs);
-      TIOGA_FREE(rhs);
       break;
     case 5:
       //
@@ -23,6 +23,8 @@
 #include "codetypes.h"
 #include <cstdlib>
 #include "mpi.h"
+#include "perfStats.h"
+#include "scratchArena.h"
 
 struct PACKET;
 
@@ -39,13 +41,20 @@ class parallelComm
   int nrecv;
   int *sndMap;
   int *rcvMap;
+  void countSent(PACKET *sndPack,int n);
+  void *allocRecv(size_t nbytes) 
+  { return (scratch) ? scratch->alloc(nbytes) : malloc(nbytes);}
+  void freeData(void *p) { if (scratch==NULL || !scratch->owns(p)) free(p);}
 
  public :
   int myid;
   int numprocs;
   MPI_Comm scomm;
+  perfStats *stats;   /** < messages sent are counted here if set */
+  scratchArena *scratch; /** < receive buffers are taken from here if set, 
+                              clearPackets leaves the arena memory alone */
   
-  parallelComm() { sndMap=NULL; rcvMap=NULL;}
+  parallelComm() { sndMap=NULL; rcvMap=NULL; stats=NULL; scratch=NULL;}
   
  ~parallelComm() { if (sndMap) free(sndMap);
                    if (rcvMap) free(rcvMap);}
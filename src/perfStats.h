@@ -0,0 +1,134 @@
+//
+// This file is part of the Tioga software library
+//
+// Tioga  is a tool for overset grid assembly on parallel distributed systems
+// Copyright (C) 2015 Jay Sitaraman
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#ifndef PERFSTATS_H
+#define PERFSTATS_H
+#include <vector>
+#include "mpi.h"
+
+/*====================================================================*/
+/*  Timed phases                                                      */
+/*====================================================================*/
+# define TIOGA_T_PROFILE          0   /* profile (preprocess)               */
+# define TIOGA_T_CONNECTIVITY     1   /* performConnectivity, inclusive      */
+# define TIOGA_T_HOLEMAP          2   /* getHoleMap                          */
+# define TIOGA_T_EXCHANGE_BOXES   3   /* exchangeBoxes                       */
+# define TIOGA_T_EXCHANGE_SEARCH  4   /* exchangeSearchData                  */
+# define TIOGA_T_SEARCH           5   /* donor search of all blocks          */
+# define TIOGA_T_EXCHANGE_DONORS  6   /* exchangeDonors                      */
+# define TIOGA_T_CELL_IBLANKS     7   /* getCellIblanks                      */
+# define TIOGA_T_CONNECTIVITY_HO  8   /* performConnectivityHighOrder        */
+# define TIOGA_T_CONNECTIVITY_AMR 9   /* performConnectivityAMR              */
+# define TIOGA_T_DATA_UPDATE      10  /* dataUpdate                          */
+# define TIOGA_T_DATA_UPDATE_AMR  11  /* dataUpdate_AMR                      */
+# define TIOGA_T_REDUCE_FRINGES   12  /* reduce_fringes                      */
+# define TIOGA_NPHASES            13
+
+/*====================================================================*/
+/*  Work counters                                                     */
+/*====================================================================*/
+# define TIOGA_C_POINTS_SENT      0   /* query points sent for search        */
+# define TIOGA_C_POINTS_RECV      1   /* query points received for search    */
+# define TIOGA_C_ADT_NODES        2   /* ADT nodes visited                   */
+# define TIOGA_C_CONTAINMENT      3   /* cell containment tests              */
+# define TIOGA_C_DONORS           4   /* donors provided to other ranks      */
+# define TIOGA_C_RECEPTORS        5   /* receptor nodes                      */
+# define TIOGA_C_MESSAGES         6   /* point to point messages sent        */
+# define TIOGA_C_BYTES            7   /* bytes sent in these messages        */
+# define TIOGA_NCOUNTERS          8
+
+/*====================================================================*/
+/*  Memory accounting (bytes)                                         */
+/*====================================================================*/
+# define TIOGA_M_ADT              0   /* ADT and element bounding boxes      */
+# define TIOGA_M_HOLEMAP          1   /* hole maps                           */
+# define TIOGA_M_QUERY            2   /* received query points               */
+# define TIOGA_M_DONORLIST        3   /* donor candidate lists               */
+# define TIOGA_M_INTERPLIST       4   /* interpolation lists                 */
+# define TIOGA_M_UNIQUENODE       5   /* duplicate query point map of search */
+# define TIOGA_M_SCRATCH          6   /* scratch arena                       */
+# define TIOGA_NMEMORY            7
+
+/* 
+ * layout of the statistics array: for each phase
+ * (time, calls, messages, bytes), then the counters
+ */
+# define TIOGA_NSTATS (4*TIOGA_NPHASES+TIOGA_NCOUNTERS)
+
+/**
+* Performance statistics
+* wall clock time of nested phases (no barriers,
+* so each rank measures its own work) and counters
+* of the work done. The messages sent are charged 
+* to the innermost running phase. */
+class perfStats
+{
+ private:
+  double tstart[TIOGA_NPHASES];
+  int depth[TIOGA_NPHASES];
+  std::vector<int> running;
+
+ public :
+  double ptime[TIOGA_NPHASES];      /** < accumulated time of each phase */
+  double pcalls[TIOGA_NPHASES];     /** < number of completed calls */
+  double pmsgs[TIOGA_NPHASES];      /** < messages sent within each phase */
+  double pbytes[TIOGA_NPHASES];     /** < bytes sent within each phase */
+  double counter[TIOGA_NCOUNTERS];  /** < work counters */
+  double mem[TIOGA_NMEMORY];        /** < bytes held by each subsystem */
+  double memPeak[TIOGA_NMEMORY];    /** < largest value of mem since the reset */
+
+  perfStats() { for(int i=0;i<TIOGA_NMEMORY;i++) mem[i]=0; reset();}
+
+  void reset(void);
+
+  void start(int phase);
+
+  void stop(int phase);
+
+  void add(int icounter,double value) { counter[icounter]+=value;}
+
+  /** bytes now held by subsystem imem, the peak follows */
+  void setMemory(int imem,double bytes)
+  { mem[imem]=bytes; if (bytes > memPeak[imem]) memPeak[imem]=bytes;}
+
+  /** copy the current and the peak memory (2*TIOGA_NMEMORY values) */
+  void getMemory(double *values);
+
+  /** min, max and average over the ranks of comm of getMemory 
+      (3*2*TIOGA_NMEMORY values), collective */
+  void reduceMemory(double *values,MPI_Comm comm);
+
+  /** account one message of nbytes to the running phase */
+  void addMessage(double nbytes);
+
+  /** copy the local statistics (TIOGA_NSTATS values) */
+  void get(double *stats);
+
+  /** min, max and average over the ranks of comm (3*TIOGA_NSTATS values), 
+      collective */
+  void reduce(double *stats,MPI_Comm comm);
+
+  static const char *phaseName(int phase);
+
+  static const char *counterName(int icounter);
+
+  static const char *memoryName(int imem);
+};
+
+#endif /* PERFSTATS_H */
@@ -0,0 +1,81 @@
+//
+// This file is part of the Tioga software library
+//
+// Tioga  is a tool for overset grid assembly on parallel distributed systems
+// Copyright (C) 2015 Jay Sitaraman
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+#include <cstddef>
+#include <vector>
+
+/**
+* Scratch memory arena
+* bump allocator for the temporaries of the connectivity
+* and data update calls. Nothing is freed individually,
+* mark/rewind release everything allocated after the mark
+* and begin resets the arena at the start of the outermost
+* call. The memory is kept, so after the first time step
+* the scratch needs no system allocations. begin/end
+* nest, only the outermost begin resets */
+class scratchArena
+{
+ private:
+  std::vector<char *> chunk;       /** < memory chunks, filled in order */
+  std::vector<size_t> chunkSize;   /** < bytes in each chunk */
+  int cur;                         /** < chunk being filled */
+  size_t used;                     /** < bytes used in chunk cur */
+  size_t base;                     /** < bytes in the chunks before cur */
+  size_t hwm;                      /** < high water mark (bytes) */
+  size_t nchunkAlloc;              /** < chunks allocated so far */
+  int depth;                       /** < begin/end nesting level */
+  void addChunk(size_t nbytes);
+
+ public :
+  scratchArena() { cur=-1;used=base=hwm=nchunkAlloc=0;depth=0;}
+
+  ~scratchArena();
+
+  /** start of a top level call, the outermost one resets the arena */
+  void begin(void);
+
+  void end(void) { if (depth > 0) depth--;}
+
+  /** nbytes of 16 byte aligned scratch, valid until rewound or reset */
+  void *alloc(size_t nbytes);
+
+  template <class T> T *get(size_t n) { return (T *)alloc(sizeof(T)*n);}
+
+  /** position of the arena, to rewind to later */
+  size_t mark(void) { return base+used;}
+
+  /** release everything allocated after mark m */
+  void rewind(size_t m);
+
+  /** true if p points into the arena */
+  bool owns(const void *p) const;
+
+  /** largest number of bytes in use at any time */
+  size_t highWater(void) const { return hwm;}
+
+  /** bytes held by the arena */
+  size_t capacity(void) const;
+
+  /** chunks allocated from the system since construction */
+  size_t chunkAllocations(void) const { return nchunkAlloc;}
+};
+
+#endif /* SCRATCHARENA_H */
@@ -29,6 +29,9 @@
 #include "CartGrid.h"
 #include "CartBlock.h"
 #include "parallelComm.h"
+#include "diagOutput.h"
+#include "perfStats.h"
+#include "scratchArena.h"
 
 /** Define a macro entry flagging the versions that are safe to use with large
  *  meshes containing element and node IDs greater than what a 4-byte signed int
@@ -60,6 +63,9 @@ class tioga
   MPI_Comm scomm;
   parallelComm *pc;
   parallelComm *pc_cart;
+  diagOutput *dg;
+  perfStats *stats;
+  scratchArena scratch;   /** < temporaries of the connectivity and update calls */
   int isym;
   int ierr;
   int myid,numprocs;
@@ -67,7 +73,6 @@ class tioga
   int *recvCount;
   //OBB *obblist;
   std::vector<OBB> obblist;
-  int iorphanPrint;
 
   //! Mesh blocks in this processor 
   std::vector<std::unique_ptr<MeshBlock> > mblocks;
@@ -86,6 +91,35 @@ class tioga
   //! q-variables registered
   double **qblock;
 
+  //! AMR connectivity is reused when nothing changed (incremental mode)
+  int amrIncremental;
+  //! patch hierarchy or patch registration changed since last AMR connectivity
+  int amrGridChanged;
+  //! coordinate signature of each mesh block at the last AMR connectivity
+  std::vector<uint64_t> amrBlockHash;
+  int checkAMRChanges(void);
+  //! per cell connectivity cost is tracked for the mesh blocks
+  int trackCost;
+  int reduceFringes;   /** < cancel the receptors beyond nfringe+1 layers of the field */
+  //! ranks listed in the load imbalance report (0: no report)
+  int reportTopk;
+  //! statistics at the start of the last performConnectivity
+  std::vector<double> reportStart;
+  //! orphan handling and receive scratch of dataUpdate(at_points=1)
+  void setupPointUpdate(void);
+  //! bytes of received query points searched at a time (0: all at once)
+  double memBudget;
+  //! query points of the intersection pairs and their exchange by rounds
+  void getQueryData(int at_points,int *nintsSend,int **int_data,
+                    int *nrealsSend,double **real_data);
+  void sendQueryData(int at_points,int iround,int nround,int *nintsSend,
+                     int **int_data,int *nrealsSend,double **real_data);
+  void exchangeSearchDataChunked(void);
+  //! current memory of the subsystems into the statistics
+  void updateMemoryUsage(void);
+  //! check (apply=0) or restore (apply=1) a connectivity file
+  int parseConnectivity(const std::vector<char>& buf,int apply);
+
 
  public:
   int ihigh;
@@ -101,11 +135,13 @@ class tioga
     {
         mb = NULL; cg=NULL; cb=NULL;
         holeMap=NULL; pc=NULL; sendCount=NULL; recvCount=NULL;
-        pc_cart = NULL;
+        pc_cart = NULL; dg=NULL; stats=NULL;
         // obblist=NULL; isym=2;ihigh=0;nblocks=0;ncart=0;ihighGlobal=0;iamrGlobal=0;
         isym=3;ihigh=0;nblocks=0;ncart=0;ihighGlobal=0;iamrGlobal=0;
         mexclude=3,nfringe=1;
         qblock=NULL;
+        amrIncremental=0;amrGridChanged=1;reportTopk=0;trackCost=0;
+        reduceFringes=1;memBudget=0;
         mblocks.clear();
         mtags.clear();
     }
@@ -175,12 +211,27 @@ class tioga
     auto& mb = mblocks[iblk];
     mb->setResolutions(nres, cres);
   }
+
+  /** block btag only moves rigidly (the cell shapes and boundary nodes
+      do not change), profile then keeps the cell and node resolutions
+      of its first call */
+  void setRigidMotion(int btag,int flag)
+  {
+    auto idxit = tag_iblk_map.find(btag);
+    int iblk = idxit->second;
+    mblocks[iblk]->setRigidMotion(flag);
+  }
   
   void setMexclude(int *mexclude_input)
   {
     mexclude=*mexclude_input;
   }
 
+  /** fringe reduction at the end of performConnectivity (on by default),
+      receptors more than nfringe+1 cells away from the field nodes are
+      turned into holes */
+  void setFringeReduction(int flag) { reduceFringes=flag;};
+
   void setNfringe(int *nfringe_input)
   {
     nfringe=*nfringe_input;
@@ -222,6 +273,30 @@ class tioga
    ihigh=1;
   }
 
+  /** batched high-order callbacks, see MeshBlock::setbatchcallback, 
+      a NULL entry keeps the per cell/point callback of setcallback */
+  void setbatchcallback(void (*f1)(int *,int *,int *),
+			void (*f2)(int *,int *,int *,double *),
+			void (*f3)(int *,int *,double *,int *,double *),
+			void (*f4)(int *,int *,double *,int *,int *,double *,double *,int *),
+			void (*f5)(int *,int *,int *,double *,int *,int *,int *,double *))
+  {
+   for(int ib=0;ib<nblocks;ib++)
+   {
+    auto& mb = mblocks[ib];
+    mb->setbatchcallback(f1,f2,f3,f4,f5);
+   }   
+   ihigh=1;
+  }
+
+  /** declare the per cell/point high-order callbacks reentrant, 
+      the inclusion tests are then spread over the OpenMP threads */
+  void setHighOrderThreadSafe(int flag)
+  {
+   for(int ib=0;ib<nblocks;ib++)
+    mblocks[ib]->setHighOrderThreadSafe(flag);
+  }
+
   void setp4estcallback(void (*f1)(double *,int *,int *,int *),
 			void (*f2) (int *,int *))
   {
@@ -242,18 +317,107 @@ class tioga
     }
   }
   
+  /** debug files written after each connectivity, TIOGA_DIAG_NONE (default),
+      TIOGA_DIAG_TEXT, TIOGA_DIAG_BINARY (per rank) or TIOGA_DIAG_COLLECTIVE */
+  void setDiagnosticOutput(int mode) { dg->mode=mode;};
+
+  void writeDiagnostics(void);
+
+  /** write the result of the last performConnectivity (iblank, iblank_cell,
+      interpolation lists and communication pattern) to <path>NNNNN.bin,
+      one file per rank, with a hash of each mesh block. Returns 1 if all
+      the ranks wrote their file, collective */
+  int writeConnectivity(const char *path);
+
+  /** restore the connectivity written by writeConnectivity in place of
+      profile and performConnectivity, the same blocks have to be registered
+      on the same number of ranks. Nothing is changed and 0 is returned 
+      if any rank's file is missing or does not match its meshes, 
+      collective */
+  int readConnectivity(const char *path);
+
+  /** phase times, work counters and messages (layout in perfStats.h,
+      TIOGA_NSTATS values), ireduce=1 gives the min, max and average 
+      over the ranks (3*TIOGA_NSTATS values) and is collective */
+  void getStatistics(double *values,int ireduce=0);
+
+  void resetStatistics(void) { stats->reset();}
+
+  /** print the min/max/avg of the statistics from rank 0, collective */
+  void printStatistics(void);
+
+  /** memory (bytes) of the ADT, hole map, query points, donor lists, interp
+      lists, uniquenode map and scratch (TIOGA_M_* in perfStats.h), the
+      current values then the peaks since resetStatistics (2*TIOGA_NMEMORY
+      values), ireduce=1 gives the min, max and average over the ranks 
+      (3*2*TIOGA_NMEMORY values) and is collective */
+  void getMemoryUsage(double *values,int ireduce=0);
+
+  /** search the received query points in chunks of about bytes of search
+      data per rank (0, the default, searches all of them at once). The 
+      points that find a donor are kept until exchangeDonors, so the budget
+      lowers the query point peak by the points without a donor only; the
+      rounds share one ADT of all the cells of a block */
+  void setMemoryBudget(double bytes) { memBudget=bytes;};
+
+  /** high water mark and size (bytes) of the scratch memory of the
+      connectivity and update calls on this rank */
+  void getScratchMemory(double *hwm,double *capacity)
+  {
+   *hwm=(double)scratch.highWater();
+   *capacity=(double)scratch.capacity();
+  }
+
+  /** write the per rank load imbalance report of every performConnectivity
+      (tioga_imbalance.csv/.json from rank 0) listing the topk slowest 
+      ranks, topk=0 turns it off */
+  void setImbalanceReport(int topk) { reportTopk=topk;};
+
+  void writeImbalanceReport(void);
+
+  /** track the per cell connectivity cost (containment tests, donated
+      points) during the searches, for repartitioning */
+  void setConnectivityWeights(int flag)
+  {
+   trackCost=flag;
+   for(int ib=0;ib<nblocks;ib++) mblocks[ib]->trackCost=flag;
+  }
+
+  /** connectivity cost weights of block btag from the last connectivity,
+      per cell (ncells) and per node (nnodes), any array can be NULL */
+  void getConnectivityWeights(int btag,int *cellTests,int *cellDonors,
+			      int *nodeCandidates,int *nodeReceptor)
+  {
+   auto idxit=tag_iblk_map.find(btag);
+   if (idxit==tag_iblk_map.end()) return;
+   mblocks[idxit->second]->getConnectivityWeights(cellTests,cellDonors,
+						  nodeCandidates,nodeReceptor);
+  }
+
+  /** reuse the AMR connectivity when neither the patches nor the mesh blocks change.
+      Every AMR connectivity first undoes the patch iblanks set by the last one,
+      except those the solver changed since then */
+  void setAMRIncremental(int flag) { amrIncremental=flag;};
+
   void set_amr_callback(void (*f1)(int *,double *,int *,double *))
   {
     cg->setcallback(f1);
   }
 
   void register_amr_global_data(int, int, double *, int *,double *, int, int);
+  /** remove and add patches of an already registered AMR hierarchy by global
+      id, the added patches use the idata/rdata format of register_amr_global_data.
+      Only the search for the receptors of the unchanged patches is saved, the
+      donor search and exchange of the next AMR connectivity cover all patches */
+  void register_amr_global_data_diff(int nremove,int *removeid,int nadd,
+				     int *idata,double *rdata);
   void set_amr_patch_count(int);
-  void register_amr_local_data(int, int ,int *, double *);  
+  /** register a Cartesian patch, qlayout is ROW (0) or COLUMN (1, native) */
+  void register_amr_local_data(int, int ,int *, double *, int qlayout=1);  
   void exchangeAMRDonors(void);
   void checkComm(void);
   void outputStatistics(void);
-  void myTimer(char const *, int);
+  void countDonors(void);
   void reduce_fringes(void);
 };
       